@@ -0,0 +1,227 @@
+//
+// Behavior checks for the approximate mode in text_rank.h.
+//
+
+#include "text_rank.h"
+
+#include <cstdlib>
+#include <thread>
+
+static int failed_num = 0;
+
+static void Check(bool cond, const string &msg) {
+    if (!cond) {
+        cerr << "FAILED: " << msg << endl;
+        failed_num++;
+    }
+}
+
+static vector<WordTerm> RunExact(string corpus, int keyword_num) {
+    TextRank text_rank(corpus);
+    return text_rank.GetKeywords(keyword_num);
+}
+
+/*关闭所有近似参数时，结果与精确模式完全相同*/
+static void CheckApproxOffEqualsExact() {
+    string corpus = "a b c d e f g;a c e g h;b d f h i j;k l m a b;n o p c d";
+    vector<WordTerm> exact = RunExact(corpus, 20);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 0, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(20);
+    Check(approx.size() == exact.size(), "approx off: keyword number");
+    for (int i = 0; i < (int) min(approx.size(), exact.size()); i++) {
+        Check(approx[i].get_importance() == exact[i].get_importance(), "approx off: importance");
+    }
+    Check(TextRank::TopKOverlap(approx, exact) == 1.0f, "approx off: overlap");
+    Check(text_rank.GetEstimatedError() >= 0, "approx off: error is estimable");
+}
+
+/*
+ * 在同样的图上用double迭代到收敛，作为分数的参考值
+ * */
+static unordered_map<string, double> FixedPoint(string corpus) {
+    unordered_map<string, unordered_set<string>> neighbors;
+    for (auto &str : split_str(corpus, ';')) {
+        vector<string> words = split_str(str, ' ');
+        int size = words.size();
+        for (int i = 0; i < size; i++) {
+            neighbors[words[i]];
+            for (int j = max(0, i - TextRank::WINDOW_SIZE); j <= i + TextRank::WINDOW_SIZE && j < size; j++) {
+                if (words[i] != words[j])
+                    neighbors[words[i]].insert(words[j]);
+            }
+        }
+    }
+    const double d = TextRank::DAMP_FACTOR;
+    unordered_map<string, double> scores;
+    for (const auto &it : neighbors)
+        scores[it.first] = 1;
+    for (int iter = 0; iter < 5000; iter++) {
+        unordered_map<string, double> new_scores;
+        for (const auto &it : neighbors) {
+            double score = 1 - d;
+            for (const auto &neighbor : it.second)
+                score += d * scores[neighbor] / neighbors[neighbor].size();
+            new_scores[it.first] = score;
+        }
+        scores = new_scores;
+    }
+    return scores;
+}
+
+/*估计的误差是每个单词的分数与收敛值之间误差的上界*/
+static void CheckErrorBound(const string &name, const string &corpus) {
+    unordered_map<string, double> fixed_point = FixedPoint(corpus);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 0, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(TextRank::MAX_KEYWORD_NUM);
+    float error = text_rank.GetEstimatedError();
+    Check(error >= 0, name + ": error is estimable");
+    //float累加本身的舍入误差
+    const double eps = 1e-5;
+    for (const auto &term : approx) {
+        double diff = fabs(term.get_importance() - fixed_point[term.get_word()]);
+        Check(diff <= error + eps, name + ": " + term.get_word() + " differs by " + to_string(diff) +
+                                   " but the estimated error is " + to_string(error));
+    }
+}
+
+static void CheckErrorBounds() {
+    //中心单词w0的行和远大于1，最大权重变化不能作为误差上界
+    CheckErrorBound("hub", "w6 w3 w0 ;w0 w8 w0 w0 ;w13 w0 ;w12 w0 w0 ;w7 w4 w1 w1 ;");
+    string corpus;
+    for (int i = 0; i < 3000; i++)
+        corpus += "w" + to_string(i * i % 97) + (i % 11 == 0 ? ";" : " ");
+    CheckErrorBound("periodic", corpus);
+}
+
+/*剪枝会删掉所有单词时不剪枝*/
+static void CheckPruneFallback() {
+    string corpus = "a;b;c;d";
+    vector<WordTerm> exact = RunExact(corpus, 20);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 1, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(20);
+    Check(exact.size() == 4, "prune fallback: exact keyword number");
+    Check(approx.size() == 4, "prune fallback: approx keyword number");
+    Check(text_rank.GetEstimatedError() >= 0, "prune fallback: graph unchanged");
+}
+
+/*剪枝改变了图时不能声称误差为0*/
+static void CheckPruneError() {
+    string corpus;
+    //i*i%97使得单词之间的分数各不相同
+    for (int i = 0; i < 3000; i++)
+        corpus += "w" + to_string(i * i % 97) + " ";
+    for (int i = 0; i < 50; i++)
+        corpus += ";lonely" + to_string(i);
+    vector<WordTerm> exact = RunExact(corpus, 20);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 1, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(20);
+    Check(approx.size() == 20, "prune: keyword number");
+    Check(text_rank.GetEstimatedError() == -1, "prune: error is not estimable");
+    Check(TextRank::TopKOverlap(approx, exact) >= 0.9f, "prune: overlap with exact");
+}
+
+/*被剪掉的单词不计入出度，与它们相邻的单词不会流失分数*/
+static void CheckPruneOutDegree() {
+    string corpus;
+    for (int i = 0; i < 3000; i++)
+        corpus += "w" + to_string(i * i % 97) + " ";
+    //每个叶子单词只有一个邻居，会被剪掉
+    for (int i = 0; i < 40; i++)
+        corpus += ";w" + to_string(i) + " leaf" + to_string(i);
+    vector<WordTerm> exact = RunExact(corpus, TextRank::MAX_KEYWORD_NUM);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 2, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(TextRank::MAX_KEYWORD_NUM);
+    Check(TextRank::TopKOverlap(approx, exact) >= 0.7f, "prune out degree: overlap with exact");
+}
+
+/*采样后的关键词与精确模式仍有较高的重合*/
+static void CheckSampling() {
+    string corpus;
+    for (int i = 0; i < 2000; i++)
+        corpus += "a b c d e f g h a c e g i j k l m a b n o p q r s t;x" + to_string(i) + " a b c;";
+    vector<WordTerm> exact = RunExact(corpus, 10);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 0, 200);
+    vector<WordTerm> approx = text_rank.GetKeywords(10);
+    Check(approx.size() == 10, "sampling: keyword number");
+    Check(text_rank.GetEstimatedError() == -1, "sampling: error is not estimable");
+    Check(TextRank::TopKOverlap(approx, exact) >= 0.7f, "sampling: overlap with exact");
+}
+
+/*文档的重复周期与采样步长相同时，采样结果仍与精确模式有较高的重合*/
+static void CheckPeriodicSampling() {
+    string corpus;
+    //2000个句子采样200个，步长为10，每10个句子中只有第一个是无关的句子
+    for (int i = 0; i < 2000; i++) {
+        if (i % 10 == 0)
+            corpus += "junk" + to_string(i) + ";";
+        else
+            corpus += "a b c d e f g h a c e g i j k l m a b n o p q r s t;";
+    }
+    vector<WordTerm> exact = RunExact(corpus, 10);
+    string approx_corpus = corpus;
+    TextRank text_rank(approx_corpus);
+    text_rank.SetApproxMode(0, 0, 200);
+    vector<WordTerm> approx = text_rank.GetKeywords(10);
+    Check(TextRank::TopKOverlap(approx, exact) >= 0.7f, "periodic sampling: overlap with exact");
+}
+
+/*超过时间预算时尽快返回，并且仍然给出关键词*/
+static void CheckTimeBudget() {
+    const int budget_ms = 100;
+    //分词之外额外允许的耗时，覆盖检查间隔和topK
+    const int slack_ms = 150;
+    string corpus;
+    for (int i = 0; i < 200000; i++)
+        corpus += "u" + to_string(i) + " ";
+    auto start = chrono::steady_clock::now();
+    TextRank text_rank(corpus);
+    text_rank.SetApproxMode(budget_ms, 0, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(20);
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    Check(approx.size() == 20, "time budget: keyword number");
+    Check(elapsed.count() < budget_ms + slack_ms, "time budget: elapsed " + to_string(elapsed.count()) + "ms");
+}
+
+/*构造之后过了很久才计算关键词时，时间预算不能已经用完*/
+static void CheckTimeBudgetStart() {
+    string corpus;
+    for (int i = 0; i < 20000; i++)
+        corpus += "w" + to_string(i * i % 997) + (i % 10 == 9 ? ";" : " ");
+    string fresh_corpus = corpus;
+    vector<WordTerm> exact = RunExact(corpus, 20);
+    TextRank text_rank(fresh_corpus);
+    text_rank.GetKeywords(20);
+    this_thread::sleep_for(chrono::milliseconds(120));
+    text_rank.SetApproxMode(100, 0, 0);
+    vector<WordTerm> approx = text_rank.GetKeywords(20);
+    Check(text_rank.GetIterNum() > 1, "time budget start: iterations");
+    Check(TextRank::TopKOverlap(approx, exact) == 1.0f, "time budget start: overlap with exact");
+}
+
+int main() {
+    CheckApproxOffEqualsExact();
+    CheckErrorBounds();
+    CheckPruneFallback();
+    CheckPruneError();
+    CheckPruneOutDegree();
+    CheckSampling();
+    CheckPeriodicSampling();
+    CheckTimeBudget();
+    CheckTimeBudgetStart();
+    if (failed_num > 0)
+        return 1;
+    cout << "check_text_rank: all checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,62 @@
+//
+// Standalone driver for the fuzz targets when they are not built with libFuzzer.
+// It replays the files given on the command line, or the built-in seeds when
+// there is none. 每个输入的前两个字节是关键词数目和最小度，之后是语料
+//
+
+#ifndef TEST_TEXT_RANK_FUZZ_DRIVER_H
+#define TEST_TEXT_RANK_FUZZ_DRIVER_H
+
+#ifndef TEXT_RANK_LIBFUZZER
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static void RunOne(int keyword_num, int min_degree, const std::string &body) {
+    std::string input;
+    input += (char) keyword_num;
+    input += (char) min_degree;
+    input += body;
+    LLVMFuzzerTestOneInput((const uint8_t *) input.data(), input.size());
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            std::ifstream fin(argv[i], std::ios::binary);
+            if (!fin) {
+                std::cerr << "cannot open " << argv[i] << std::endl;
+                return 1;
+            }
+            std::stringstream buffer;
+            buffer << fin.rdbuf();
+            std::string input = buffer.str();
+            LLVMFuzzerTestOneInput((const uint8_t *) input.data(), input.size());
+        }
+        return 0;
+    }
+
+    //内置样例：空文档、只有分隔符、负数和超大的关键词数目、重复单词
+    RunOne(5, 1, "");
+    RunOne(5, 1, ";;;;   ; ;");
+    RunOne(-1, 0, "a b c;d e f");
+    RunOne(127, 3, "a b c d e f g h i j k l m n o p q r s t u v w x y z a b c");
+    RunOne(30, 2, "a a a a;a a;a");
+    RunOne(30, 2, std::string("a\0b c;d", 7));
+    std::string giant;
+    for (int i = 0; i < 2000; i++)
+        giant += "w" + std::to_string(i % 97) + " ";
+    RunOne(30, 0, giant);
+    RunOne(20, 1, "\t\n;\r \xff\xfe ;;a\tb;c  d");
+    std::cout << argv[0] << ": all seeds passed" << std::endl;
+    return 0;
+}
+
+#endif
+
+#endif //TEST_TEXT_RANK_FUZZ_DRIVER_H
@@ -0,0 +1,89 @@
+//
+// Fuzz target for split_str, GetKeywords and the C ABI in main.cpp.
+// main.cpp is linked into this target with TEXT_RANK_NO_MAIN defined.
+//
+// 使用libFuzzer(需要clang):
+//   cmake -S . -B build -DCMAKE_CXX_COMPILER=clang++ -DTEXT_RANK_FUZZ=ON
+//   ./build/fuzz_main_text_rank -max_len=65536
+// 不使用libFuzzer时使用fuzz_driver.h中的main回放样例
+//
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+//以下函数定义在main.cpp中
+vector<string> split_str(string &ori_str, char separator);
+
+extern "C" char *text_rank_wrapper(char *corpus, int keyword_num);
+
+/*
+ * 统计语料中的单词，分词方式与TextRank的构造函数相同
+ * */
+static unordered_set<string> CollectWords(string corpus) {
+    unordered_set<string> words;
+    for (auto &str : split_str(corpus, ';')) {
+        for (auto &word : split_str(str, ' '))
+            words.insert(word);
+    }
+    return words;
+}
+
+/*
+ * 检查C接口返回的"单词 单词 ;分数 分数 "格式的结果，非法时直接abort
+ * */
+static void CheckResult(const string &res_str, int keyword_num, const unordered_set<string> &words) {
+    size_t pos = res_str.find(';');
+    if (pos == string::npos)
+        abort();
+    //单词中可能有制表符等空白字符，只能按空格切分
+    string word_str = res_str.substr(0, pos);
+    string score_str = res_str.substr(pos + 1);
+    vector<string> res_words = split_str(word_str, ' ');
+    vector<string> res_scores = split_str(score_str, ' ');
+    for (const auto &word : res_words) {
+        if (words.find(word) == words.end())
+            abort();
+    }
+    for (const auto &score : res_scores) {
+        float importance = strtof(score.c_str(), nullptr);
+        if (!std::isfinite(importance) || importance < 0)
+            abort();
+    }
+    int word_cnt = res_words.size();
+    int score_cnt = res_scores.size();
+    int expect_max = max(0, min(keyword_num, 30));
+    if (word_cnt > expect_max || word_cnt > (int) words.size() || score_cnt != word_cnt)
+        abort();
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2)
+        return 0;
+    //第一个字节是关键词数目，第二个字节在main.cpp中没有用到
+    int keyword_num = (int8_t) data[0];
+    string text((const char *) data + 2, size - 2);
+
+    //split_str会修改传入的字符串，每次使用拷贝
+    for (char separator : {';', ' ', '\0'}) {
+        string tem = text;
+        for (const auto &sub : split_str(tem, separator)) {
+            if (sub.empty() || sub.find(separator) != string::npos)
+                abort();
+        }
+    }
+
+    //C接口要求以'\0'结尾
+    string corpus = text.c_str();
+    unordered_set<string> words = CollectWords(corpus);
+    string res_str = text_rank_wrapper((char *) corpus.c_str(), keyword_num);
+    CheckResult(res_str, keyword_num, words);
+    return 0;
+}
+
+#include "fuzz_driver.h"
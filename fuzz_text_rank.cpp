@@ -0,0 +1,76 @@
+//
+// Fuzz target for split_str, the graph builder and the C ABI in text_rank.h.
+//
+// 使用libFuzzer(需要clang):
+//   cmake -S . -B build -DCMAKE_CXX_COMPILER=clang++ -DTEXT_RANK_FUZZ=ON
+//   ./build/fuzz_text_rank -max_len=65536
+// 不使用libFuzzer时使用fuzz_driver.h中的main回放样例
+//
+
+#include "text_rank.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+/*
+ * 统计语料中不同单词的数目，分词方式与TextRank的构造函数相同
+ * */
+static int CountWords(string corpus) {
+    unordered_set<string> words;
+    for (auto &str : split_str(corpus, ';')) {
+        for (auto &word : split_str(str, ' '))
+            words.insert(word);
+    }
+    return words.size();
+}
+
+/*
+ * 检查C接口返回的结果是否合法，非法时直接abort，便于fuzzer记录崩溃样例
+ * result[0]是关键词数目，之后依次是关键词编号和关键词分数*100
+ * */
+static void CheckResult(const int *res, int keyword_num, int word_num) {
+    int expect_max = max(0, min(keyword_num, (int) TextRank::MAX_KEYWORD_NUM));
+    if (res[0] < 0 || res[0] > expect_max || res[0] > word_num)
+        abort();
+    for (int i = 0; i < res[0]; i++) {
+        if (res[i + 1] < 0 || res[i + 1] >= word_num)
+            abort();
+    }
+    //每个单词的分数不超过单词总数
+    for (int i = 0; i < res[0]; i++) {
+        int importance = res[res[0] + i + 1];
+        if (importance < 0 || importance > 100 * (word_num + 1))
+            abort();
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 2)
+        return 0;
+    //前两个字节用于生成参数，覆盖负数和超过MAX_KEYWORD_NUM的情况
+    int keyword_num = (int8_t) data[0];
+    int min_degree = data[1] % 8;
+    string text((const char *) data + 2, size - 2);
+
+    //split_str会修改传入的字符串，每次使用拷贝
+    for (char separator : {';', ' ', '\0'}) {
+        string tem = text;
+        for (const auto &sub : split_str(tem, separator)) {
+            if (sub.empty() || sub.find(separator) != string::npos)
+                abort();
+        }
+    }
+
+    //C接口要求以'\0'结尾
+    string corpus = text.c_str();
+    int word_num = CountWords(corpus);
+    int *res = text_rank_wrapper((char *) corpus.c_str(), keyword_num);
+    CheckResult(res, keyword_num, word_num);
+    res = text_rank_approx_wrapper((char *) corpus.c_str(), keyword_num, 0, min_degree, 16);
+    CheckResult(res, keyword_num, word_num);
+    if (!(text_rank_approx_error() >= 0 || text_rank_approx_error() == -1))
+        abort();
+    return 0;
+}
+
+#include "fuzz_driver.h"
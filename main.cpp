@@ -9,6 +9,7 @@
 #include <map>
 #include <queue>
 #include <set>
+#include <cmath>
 
 using namespace std;
 
@@ -123,17 +124,17 @@ public:
 };
 
 vector<string> split_str(string &ori_str, char separator) {
-    vector<int> pos_vec;
+    vector<size_t> pos_vec;
     ori_str = separator + ori_str + separator;
-    int len = ori_str.length();
-    for (int i = 0; i < len; i++)
+    size_t len = ori_str.length();
+    for (size_t i = 0; i < len; i++)
         if (ori_str[i] == separator) {
             pos_vec.push_back(i);
         }
 
     vector<string> res;
-    int size = pos_vec.size();
-    for (int i = 0; i < size - 1; i++) {
+    size_t size = pos_vec.size();
+    for (size_t i = 0; i + 1 < size; i++) {
         string sub = ori_str.substr(pos_vec[i] + 1, pos_vec[i + 1] - pos_vec[i] - 1);
         if (!sub.empty())
             res.push_back(sub);
@@ -152,7 +153,7 @@ vector<T> topK(const vector<T> &vec, int K) {
     }
     priority_queue<T, vector<T>, greater<>> minQ;
     for (auto x:vec) {
-        if (minQ.size() < K) {
+        if ((int) minQ.size() < K) {
             minQ.push(x);
         }
             //minQ.top()是minQ中最小的数
@@ -308,6 +309,11 @@ vector<WordTerm> TextRank::GetKeywords(int keyword_num) {
 //    keyword_num = min(keyword_num, MAX_KEYWORD_NUM);
     if (keyword_num > MAX_KEYWORD_NUM)
         keyword_num = MAX_KEYWORD_NUM;
+    //负数与size()比较时会被转换为无符号数，需要先处理
+    if (keyword_num < 0)
+        keyword_num = 0;
+    if (keyword_num > (int) this->keywords.size())
+        keyword_num = this->keywords.size();
     vector<WordTerm> res;
     res.reserve(keyword_num);
     for (int i = 0; i < keyword_num; i++) {
@@ -343,6 +349,10 @@ string res_str;
 
 extern "C" {
 char *text_rank_wrapper(char *corpus, int keyword_num) {
+    if (corpus == nullptr) {
+        res_str = ";";
+        return (char *) res_str.c_str();
+    }
     string param_corpus = corpus;
     TextRank text_rank = TextRank(param_corpus);
     vector<WordTerm> res_vec = text_rank.GetKeywords(keyword_num);
@@ -374,8 +384,11 @@ void TestTextRank() {
     cout<<(double)(clock() - start) /CLOCKS_PER_SEC<<endl;
 }
 
+//测试和fuzz程序链接本文件时定义TEXT_RANK_NO_MAIN
+#ifndef TEXT_RANK_NO_MAIN
 int main() {
     std::cout << "Hello, World!" << std::endl;
     TestTextRank();
     return 0;
 }
+#endif
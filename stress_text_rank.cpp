@@ -0,0 +1,183 @@
+//
+// Scale stress test for text_rank.h: runs pathological inputs of growing size
+// and records time and peak memory for each of them. Every run happens in a
+// forked child so that the peak memory of one run does not leak into the next.
+//
+// 用法: ./stress_text_rank [max_size]
+// max_size默认为10000，传入1000000可以测试百万级的单词
+//
+
+#include "text_rank.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/*
+ * 获取进程的峰值内存(KB)，优先读取VmHWM，失败时使用getrusage
+ * */
+static long GetPeakMemoryKB() {
+    ifstream fin("/proc/self/status");
+    string line;
+    while (getline(fin, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return atol(line.c_str() + 6);
+    }
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*单个句子，只有vocab_size个不同的单词*/
+static string GiantSentence(int size, int vocab_size) {
+    string s;
+    for (int i = 0; i < size; i++)
+        s += "w" + to_string(i % vocab_size) + " ";
+    return s;
+}
+
+/*全部是不同的单词，每个句子sentence_len个单词*/
+static string UniqueTokens(int size, int sentence_len) {
+    string s;
+    for (int i = 0; i < size; i++) {
+        s += "u" + to_string(i);
+        s += (i + 1) % sentence_len == 0 ? ";" : " ";
+    }
+    return s;
+}
+
+/*连续的分隔符和空句子*/
+static string Separators(int size) {
+    string s;
+    for (int i = 0; i < size; i++)
+        s += i % 7 == 0 ? "w" + to_string(i % 13) : (i % 3 == 0 ? ";" : " ");
+    return s;
+}
+
+struct StressCase {
+    string name;
+    function<string(int)> generate;
+};
+
+struct RunResult {
+    double ms;
+    long peak_kb;
+    float error;
+    vector<WordTerm> keywords;
+};
+
+/*
+ * 在子进程中生成语料并运行一次，通过管道返回耗时、峰值内存、误差和关键词
+ * 子进程崩溃或结果非法时返回false
+ * */
+static bool RunOnce(const StressCase &c, int size, bool approx, RunResult &run_result) {
+    const int keyword_num = 20;
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    cout.flush();
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0) {
+        close(fds[0]);
+        string corpus = c.generate(size);
+        auto start = chrono::steady_clock::now();
+        TextRank text_rank(corpus);
+        if (approx)
+            text_rank.SetApproxMode(100, 2, 1000);
+        vector<WordTerm> keywords = text_rank.GetKeywords(keyword_num);
+        text_rank.TransformKeywords(keywords);
+        auto end = chrono::steady_clock::now();
+        if (result[0] < 0 || result[0] > keyword_num)
+            _exit(1);
+        stringstream out;
+        out << chrono::duration<double, milli>(end - start).count() << " " << GetPeakMemoryKB() << " "
+            << text_rank.GetEstimatedError();
+        for (const auto &term : keywords)
+            out << " " << term.get_word();
+        string out_str = out.str();
+        size_t written = 0;
+        while (written < out_str.size()) {
+            ssize_t n = write(fds[1], out_str.data() + written, out_str.size() - written);
+            if (n <= 0)
+                _exit(1);
+            written += n;
+        }
+        close(fds[1]);
+        _exit(0);
+    }
+
+    close(fds[1]);
+    string in_str;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        in_str.append(buffer, n);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return false;
+
+    stringstream in(in_str);
+    in >> run_result.ms >> run_result.peak_kb >> run_result.error;
+    run_result.keywords.clear();
+    string word;
+    while (in >> word)
+        run_result.keywords.emplace_back(word, 0);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int max_size = 10000;
+    if (argc > 1)
+        max_size = atoi(argv[1]);
+
+    vector<StressCase> cases = {
+            {"empty",          [](int) { return string(); }},
+            {"separators",     Separators},
+            {"giant_sentence", [](int size) { return GiantSentence(size, 1000); }},
+            {"unique_one",     [](int size) { return UniqueTokens(size, size); }},
+            {"unique_short",   [](int size) { return UniqueTokens(size, 10); }},
+    };
+    //规模每增大10倍，耗时最多允许增大的倍数，n*log(n)约为13倍，n^2为100倍
+    const double MAX_GROWTH = 25;
+    //耗时太短时误差较大，相邻两个规模的耗时都超过该值时才做检查
+    const double MIN_CHECK_MS = 50;
+
+    bool failed = false;
+    //overlap是近似模式与精确模式关键词的重合比例，error是GetEstimatedError的结果
+    cout << "case,mode,size,ms,peak_kb,keywords,overlap,error" << endl;
+    for (const auto &c : cases) {
+        double last_ms[2] = {-1, -1};
+        for (int size = 1000; size <= max_size; size *= 10) {
+            vector<WordTerm> exact_keywords;
+            for (bool approx : {false, true}) {
+                const char *mode = approx ? "approx" : "exact";
+                RunResult run_result;
+                if (!RunOnce(c, size, approx, run_result)) {
+                    cerr << c.name << "," << mode << "," << size << ": crashed or invalid result" << endl;
+                    failed = true;
+                    continue;
+                }
+                if (!approx)
+                    exact_keywords = run_result.keywords;
+                cout << c.name << "," << mode << "," << size << "," << run_result.ms << "," << run_result.peak_kb
+                     << "," << run_result.keywords.size() << ","
+                     << TextRank::TopKOverlap(run_result.keywords, exact_keywords) << "," << run_result.error << endl;
+                double &prev_ms = last_ms[approx];
+                if (prev_ms > MIN_CHECK_MS && run_result.ms > MIN_CHECK_MS && run_result.ms > prev_ms * MAX_GROWTH) {
+                    cerr << c.name << "," << mode << ": superlinear growth at size " << size << endl;
+                    failed = true;
+                }
+                prev_ms = run_result.ms;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -9,6 +9,9 @@
 #include <unordered_map>
 #include <queue>
 #include <unordered_set>
+#include <chrono>
+#include <cmath>
+#include <climits>
 
 using namespace std;
 
@@ -65,17 +68,17 @@ bool WordTerm::operator>(const WordTerm &other) const {
 }
 
 vector<string> split_str(string &ori_str, char separator) {
-    vector<int> pos_vec;
+    vector<size_t> pos_vec;
     ori_str = separator + ori_str + separator;
-    int len = ori_str.length();
-    for (int i = 0; i < len; i++)
+    size_t len = ori_str.length();
+    for (size_t i = 0; i < len; i++)
         if (ori_str[i] == separator) {
             pos_vec.push_back(i);
         }
 
     vector<string> res;
-    int size = pos_vec.size();
-    for (int i = 0; i < size - 1; i++) {
+    size_t size = pos_vec.size();
+    for (size_t i = 0; i + 1 < size; i++) {
         string sub = ori_str.substr(pos_vec[i] + 1, pos_vec[i + 1] - pos_vec[i] - 1);
         if (!sub.empty())
             res.push_back(sub);
@@ -94,7 +97,7 @@ vector<T> topK(const vector<T> &vec, int K) {
     }
     priority_queue<T, vector<T>, greater<>> minQ;
     for (const auto &x:vec) {
-        if (minQ.size() < K) {
+        if ((int) minQ.size() < K) {
             minQ.push(x);
         }
             //minQ.top()是minQ中最小的数
@@ -116,20 +119,48 @@ vector<T> topK(const vector<T> &vec, int K) {
 
 class TextRank {
 private:
-    /*corpus是迭代训练的语料*/
-    vector<vector<string>> corpus;
+    /*raw_corpus是未分词的语料，分词在第一次计算关键词时进行*/
+    string raw_corpus;
+    /*tokenized表示raw_corpus是否已经分词*/
+    bool tokenized;
+    /*truncated表示分词时超过了时间预算，只使用了部分语料*/
+    bool truncated;
+    /*corpus是迭代训练的语料，单词用编号表示*/
+    vector<vector<int>> corpus;
     /*keywords是训练得到的关键词*/
     vector<WordTerm> keywords;
     /*word_weights保存了每个单词的分数，分数越大越是关键词*/
     unordered_map<string, float> word_scores;
     /*word_ids保存了每个单词的编号*/
     unordered_map<string, int> word_ids;
+    /*id_words保存了每个编号对应的单词*/
+    vector<string> id_words;
     /*keyword_num保存了每次查询的关键词数目*/
     int keyword_num;
+    /*approx_mode表示是否开启近似模式，用于超长文档*/
+    bool approx_mode;
+    /*time_budget_ms是近似模式下的时间预算(毫秒)，从开始计算关键词时计时，<=0表示不限制*/
+    int time_budget_ms;
+    /*start_time保存了开始计算关键词的时间，分词的耗时也计入时间预算*/
+    chrono::steady_clock::time_point start_time;
+    /*min_degree是近似模式下保留的最小邻居数，度更小的单词不参与迭代*/
+    int min_degree;
+    /*max_sentence_num是近似模式下最多采样的句子数，<=0表示不采样*/
+    int max_sentence_num;
+    /*iter_num保存了实际的迭代次数*/
+    int iter_num;
+    /*last_diff保存了最后一次迭代所有单词权重变化的绝对值之和(L1范数)*/
+    double last_diff;
+    /*graph_changed表示采样、剪枝或超时使得图与精确模式不同*/
+    bool graph_changed;
+
+    void Tokenize();
 
     void calWordScores();
 
-    unordered_map<string, unordered_set<string>> GetWordNeighbors();
+    bool IsTimeout() const;
+
+    vector<vector<int>> GetWordNeighbors(vector<bool> &in_graph);
 
     vector<WordTerm> GenerateTopKeywords();
 
@@ -151,6 +182,14 @@ public:
 
     vector<WordTerm> GetKeywords(int p_keyword_num);
 
+    void SetApproxMode(int p_time_budget_ms, int p_min_degree, int p_max_sentence_num);
+
+    int GetIterNum() const;
+
+    float GetEstimatedError() const;
+
+    static float TopKOverlap(const vector<WordTerm> &approx_terms, const vector<WordTerm> &exact_terms);
+
     void TransformKeywords(const vector<WordTerm> &term_vec);
 };
 
@@ -159,7 +198,19 @@ TextRank::TextRank() {
     this->keywords.clear();
     this->word_scores.clear();
     this->word_ids.clear();
+    this->id_words.clear();
     this->keyword_num = 0;
+    this->approx_mode = false;
+    this->time_budget_ms = 0;
+    this->min_degree = 0;
+    this->max_sentence_num = 0;
+    this->iter_num = 0;
+    this->last_diff = 0;
+    this->graph_changed = false;
+    this->start_time = chrono::steady_clock::now();
+    this->raw_corpus.clear();
+    this->tokenized = true;
+    this->truncated = false;
 }
 
 TextRank::TextRank(string &corpus) {
@@ -167,82 +218,234 @@ TextRank::TextRank(string &corpus) {
     this->keywords.clear();
     this->word_scores.clear();
     this->word_ids.clear();
+    this->id_words.clear();
     this->keyword_num = 0;
-    int cnt = 0;
-    vector<string> str_vec = split_str(corpus, ';');
-    for (auto &str:str_vec) {
-        const vector<string> tem_vec = split_str(str, ' ');
-        if (!tem_vec.empty()) {
-            this->corpus.push_back(tem_vec);
-            for (const auto &word:tem_vec) {
-                if (this->word_ids.find(word) == this->word_ids.end()) {
-                    this->word_ids[word] = cnt;
-                    cnt++;
-                }
+    this->approx_mode = false;
+    this->time_budget_ms = 0;
+    this->min_degree = 0;
+    this->max_sentence_num = 0;
+    this->iter_num = 0;
+    this->last_diff = 0;
+    this->graph_changed = false;
+    this->start_time = chrono::steady_clock::now();
+    this->raw_corpus = corpus;
+    this->tokenized = false;
+    this->truncated = false;
+}
+
+/*
+ * 把raw_corpus切分为句子和单词，效果与先按';'再按' '调用split_str相同
+ * 近似模式下每隔256个单词检查一次时间预算，超时则只使用已经切分的部分
+ * */
+void TextRank::Tokenize() {
+    if (this->tokenized)
+        return;
+    this->tokenized = true;
+    int cnt = this->id_words.size();
+    int token_cnt = 0;
+    vector<int> id_vec;
+    string word;
+    size_t len = this->raw_corpus.size();
+    size_t start = 0;
+    for (size_t i = 0; i <= len; i++) {
+        char ch = i < len ? this->raw_corpus[i] : ';';
+        if (ch != ' ' && ch != ';')
+            continue;
+        if (i > start) {
+            word.assign(this->raw_corpus, start, i - start);
+            auto id_it = this->word_ids.find(word);
+            if (id_it == this->word_ids.end()) {
+                this->word_ids[word] = cnt;
+                this->id_words.push_back(word);
+                id_vec.push_back(cnt);
+                cnt++;
+            } else {
+                id_vec.push_back(id_it->second);
             }
+            if (++token_cnt % 256 == 0 && this->IsTimeout()) {
+                this->truncated = true;
+                break;
+            }
+        }
+        start = i + 1;
+        if (ch == ';' && !id_vec.empty()) {
+            this->corpus.push_back(id_vec);
+            id_vec.clear();
         }
     }
+    if (!id_vec.empty())
+        this->corpus.push_back(id_vec);
+    string().swap(this->raw_corpus);
 }
 
 float Sigmod(float x) {
     return 1.0f / (1.0f + exp(-x));
 }
 
+bool TextRank::IsTimeout() const {
+    if (!this->approx_mode || this->time_budget_ms <= 0)
+        return false;
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - this->start_time);
+    return elapsed.count() >= this->time_budget_ms;
+}
+
 void TextRank::calWordScores() {
-    unordered_map<string, unordered_set<string>> word_neighbors = GetWordNeighbors();
-    /*依据TF来设置word_scores的初值*/
-    this->word_scores.clear();
-    for (const auto &it:word_neighbors)
-        this->word_scores[it.first] = Sigmod(it.second.size());
+    //构造和SetApproxMode之后可能过了很久，时间预算从这里开始计算
+    this->start_time = chrono::steady_clock::now();
+    this->Tokenize();
+    this->graph_changed = this->truncated;
+    //图中的单词都用编号表示，in_graph表示单词是否参与迭代
+    vector<bool> in_graph;
+    vector<vector<int>> word_neighbors = GetWordNeighbors(in_graph);
+    int word_num = word_neighbors.size();
+    /*近似模式下剪掉度较小的单词，它们几乎不可能成为关键词*/
+    if (this->approx_mode && this->min_degree > 0) {
+        int graph_num = 0;
+        int kept_num = 0;
+        for (int k = 0; k < word_num; k++) {
+            if (!in_graph[k])
+                continue;
+            graph_num++;
+            if ((int) word_neighbors[k].size() >= this->min_degree)
+                kept_num++;
+        }
+        //剩下的单词不够MAX_KEYWORD_NUM个时不剪枝，避免丢掉关键词
+        if (kept_num >= MAX_KEYWORD_NUM && kept_num < graph_num) {
+            for (int k = 0; k < word_num; k++) {
+                if ((int) word_neighbors[k].size() < this->min_degree)
+                    in_graph[k] = false;
+            }
+            this->graph_changed = true;
+        }
+    }
+    //出度只统计仍在图中的邻居，否则与被剪掉的单词相邻的单词会不断流失分数
+    vector<int> out_degree(word_num, 0);
+    for (int k = 0; k < word_num; k++) {
+        if (!in_graph[k])
+            continue;
+        for (int neighbor_word:word_neighbors[k]) {
+            if (in_graph[neighbor_word])
+                out_degree[k]++;
+        }
+    }
+    /*依据TF来设置分数的初值*/
+    vector<float> scores(word_num, 0);
+    for (int k = 0; k < word_num; k++) {
+        if (in_graph[k])
+            scores[k] = Sigmod(word_neighbors[k].size());
+    }
 
+    this->iter_num = 0;
+    this->last_diff = 0;
+    vector<float> new_scores(word_num, 0);
     for (int i = 0; i < MAX_ITER; i++) {
-        unordered_map<string, float> new_scores_map;
-        for (const auto &it:word_neighbors)
-            new_scores_map[it.first] = 0;
         float max_diff = 0;
+        double sum_diff = 0;
+        bool timeout = false;
+        int vertex_cnt = 0;
         //遍历每一个单词cur_word
-        for (const auto &it:word_neighbors) {
-            string cur_word = it.first;
-            auto all_neighbors = it.second;
+        for (int cur_word = 0; cur_word < word_num; cur_word++) {
+            if (!in_graph[cur_word])
+                continue;
+            //每隔256个单词检查一次时间预算，超时则放弃本轮迭代
+            if (++vertex_cnt % 256 == 0 && this->IsTimeout()) {
+                timeout = true;
+                break;
+            }
             float new_score = 1 - DAMP_FACTOR;
-            //遍历cur_word的每一个邻居
-            for (auto &neighbor_word:all_neighbors) {
-                int out_size = word_neighbors[neighbor_word].size();
-                if (cur_word == neighbor_word || out_size == 0)
+            //遍历cur_word的每一个邻居，被剪掉的邻居不参与计算
+            for (int neighbor_word:word_neighbors[cur_word]) {
+                int out_size = out_degree[neighbor_word];
+                if (!in_graph[neighbor_word] || out_size == 0)
                     continue;
-                float neighbor_score = this->word_scores[neighbor_word];
-                new_score += DAMP_FACTOR * neighbor_score / (float) out_size;
+                new_score += DAMP_FACTOR * scores[neighbor_word] / (float) out_size;
             }
-            new_scores_map[cur_word] += new_score;
-
-            float cur_score = this->word_scores[cur_word];
-            max_diff = max(max_diff, abs(new_score - cur_score));
+            new_scores[cur_word] = new_score;
+            max_diff = max(max_diff, abs(new_score - scores[cur_word]));
+            sum_diff += abs(new_score - scores[cur_word]);
         }
+        //超时时保留上一轮的分数，第一轮就超时则使用依据度设置的初值
+        if (timeout)
+            break;
 
-        this->word_scores = new_scores_map;
-        if (max_diff <= MIN_DIFF)
+        scores.swap(new_scores);
+        this->iter_num = i + 1;
+        this->last_diff = sum_diff;
+        if (max_diff <= MIN_DIFF || this->IsTimeout())
             break;
     }
+
+    this->word_scores.clear();
+    for (int k = 0; k < word_num; k++) {
+        if (in_graph[k])
+            this->word_scores[this->id_words[k]] = scores[k];
+    }
+}
+
+/*
+ * 整数哈希，用于在每个采样区间内选取句子，结果只依赖于区间编号，保证可复现
+ * */
+unsigned int HashIndex(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
 }
 
-unordered_map<string, unordered_set<string>> TextRank::GetWordNeighbors() {
-    unordered_map<string, unordered_set<string>> word_neighbors;
+vector<vector<int>> TextRank::GetWordNeighbors(vector<bool> &in_graph) {
+    int word_num = this->id_words.size();
+    vector<vector<int>> word_neighbors(word_num);
+    in_graph.assign(word_num, false);
+    //近似模式下把句子按step分为区间，每个区间依据哈希选取一个句子
+    //固定步长采样会与周期重复的文档对齐，导致采样结果严重偏斜
+    int corpus_size = this->corpus.size();
+    int step = 1;
+    if (this->approx_mode && this->max_sentence_num > 0 && corpus_size > this->max_sentence_num) {
+        step = (corpus_size + this->max_sentence_num - 1) / this->max_sentence_num;
+        this->graph_changed = true;
+    }
+    //dedup_size保存了每个单词上一次去重后的邻居数，邻居数翻倍时再去重一次
+    vector<int> dedup_size(word_num, 0);
+    int word_cnt = 0;
+    bool timeout = false;
     //遍历每一个句子
-    for (auto word_vec:this->corpus) {
-        int size = word_vec.size();
+    for (int bucket = 0; bucket < corpus_size && !timeout; bucket += step) {
+        int k = bucket;
+        if (step > 1)
+            k += HashIndex(bucket / step) % min(step, corpus_size - bucket);
+        const auto &id_vec = this->corpus[k];
+        int size = id_vec.size();
         //遍历每一个单词
         for (int i = 0; i < size; i++) {
-            auto cur_word = word_vec[i];
-            if (word_neighbors.find(cur_word) == word_neighbors.end())
-                word_neighbors[cur_word] = unordered_set<string>();
-
+            //每隔256个单词检查一次时间预算，超时则只使用已经建好的部分图
+            if (++word_cnt % 256 == 0 && this->IsTimeout()) {
+                this->graph_changed = true;
+                timeout = true;
+                break;
+            }
+            int cur_word = id_vec[i];
+            auto &neighbors = word_neighbors[cur_word];
+            in_graph[cur_word] = true;
             for (int j = max(0, i - WINDOW_SIZE); j <= i + WINDOW_SIZE && j < size; j++) {
-                if (cur_word != word_vec[j]) {
-                    word_neighbors[cur_word].insert(word_vec[j]);
+                if (cur_word != id_vec[j]) {
+                    neighbors.push_back(id_vec[j]);
                 }
             }
+            //高频单词的邻居大量重复，及时去重使得超时后的最终去重足够快
+            if ((int) neighbors.size() > 2 * dedup_size[cur_word] + 4 * WINDOW_SIZE) {
+                sort(neighbors.begin(), neighbors.end());
+                neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+                dedup_size[cur_word] = neighbors.size();
+            }
         }
     }
+    //去掉重复的邻居
+    for (auto &neighbors:word_neighbors) {
+        sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
     return word_neighbors;
 }
 
@@ -265,7 +468,10 @@ vector<WordTerm> TextRank::GetKeywords(int p_keyword_num) {
 //    p_keyword_num = min(p_keyword_num, MAX_KEYWORD_NUM);
     if (p_keyword_num > MAX_KEYWORD_NUM)
         p_keyword_num = MAX_KEYWORD_NUM;
-    if (p_keyword_num > this->keywords.size())
+    //负数与size()比较时会被转换为无符号数，需要先处理
+    if (p_keyword_num < 0)
+        p_keyword_num = 0;
+    if (p_keyword_num > (int) this->keywords.size())
         p_keyword_num = this->keywords.size();
     this->keyword_num = p_keyword_num;
     vector<WordTerm> res;
@@ -276,17 +482,70 @@ vector<WordTerm> TextRank::GetKeywords(int p_keyword_num) {
     return res;
 }
 
-int result[TextRank::MAX_KEYWORD_NUM + 1];
+void TextRank::SetApproxMode(int p_time_budget_ms, int p_min_degree, int p_max_sentence_num) {
+    this->approx_mode = true;
+    this->time_budget_ms = p_time_budget_ms;
+    this->min_degree = p_min_degree;
+    this->max_sentence_num = p_max_sentence_num;
+    //参数变化后需要重新计算关键词
+    this->keywords.clear();
+}
+
+int TextRank::GetIterNum() const {
+    return this->iter_num;
+}
+
+/*
+ * 依据最后一次迭代的权重变化估计每个单词的分数与收敛值之间的误差上界
+ * 邻居的分数按其出度均分，迭代矩阵每一列的和不超过1，因此迭代在L1范数下是系数为DAMP_FACTOR的压缩映射，
+ * L1误差不超过 d/(1-d) * last_diff，单个单词的误差也不超过这个值
+ * 注意最大权重变化(L∞)不能给出这样的上界，度很大的单词所在的行和可能远大于1
+ * 采样、剪枝或超时改变了图时无法用这种方式估计，返回-1，需要用TopKOverlap与精确模式对比
+ * */
+float TextRank::GetEstimatedError() const {
+    if (this->graph_changed)
+        return -1;
+    //没有完成任何一轮迭代，只有空图的结果是精确的
+    if (this->iter_num == 0)
+        return this->word_scores.empty() ? 0 : -1;
+    return (float) (DAMP_FACTOR / (1 - DAMP_FACTOR) * this->last_diff);
+}
+
+/*
+ * 计算近似模式与精确模式得到的关键词的重合比例，取值为[0, 1]
+ * */
+float TextRank::TopKOverlap(const vector<WordTerm> &approx_terms, const vector<WordTerm> &exact_terms) {
+    if (exact_terms.empty())
+        return approx_terms.empty() ? 1.0f : 0.0f;
+    unordered_set<string> exact_words;
+    for (const auto &term:exact_terms)
+        exact_words.insert(term.get_word());
+    int hit = 0;
+    for (const auto &term:approx_terms) {
+        if (exact_words.find(term.get_word()) != exact_words.end())
+            hit++;
+    }
+    return (float) hit / (float) exact_terms.size();
+}
+
+//result[0]是关键词数目，之后依次是关键词编号和关键词分数
+int result[2 * TextRank::MAX_KEYWORD_NUM + 1];
+float approx_error;
 
 void TextRank::TransformKeywords(const vector<WordTerm> &term_vec) {
-    result[0] = term_vec.size();
-    for (int i = 0; i < term_vec.size(); i++) {
+    int term_num = min((int) term_vec.size(), (int) MAX_KEYWORD_NUM);
+    result[0] = term_num;
+    for (int i = 0; i < term_num; i++) {
         string word = term_vec[i].get_word();
         result[i + 1] = this->word_ids[word];
     }
-    for (int i = 0; i < term_vec.size(); i++) {
-        int importance = int(term_vec[i].get_importance() * 100);
-        result[this->keyword_num + i + 1] = importance;
+    for (int i = 0; i < term_num; i++) {
+        //非有限值或超出int范围的浮点数直接转换为int是未定义行为
+        double importance = term_vec[i].get_importance() * 100.0;
+        if (!std::isfinite(importance))
+            importance = 0;
+        importance = max(min(importance, (double) INT_MAX), (double) INT_MIN);
+        result[term_num + i + 1] = int(importance);
     }
 }
 
@@ -294,10 +553,41 @@ void TextRank::TransformKeywords(const vector<WordTerm> &term_vec) {
 
 extern "C" {
 int *text_rank_wrapper(char *corpus, int keyword_num) {
+    if (corpus == nullptr) {
+        result[0] = 0;
+        return result;
+    }
     string param_corpus = corpus;
     TextRank text_rank = TextRank(param_corpus);
     vector<WordTerm> res_vec = text_rank.GetKeywords(keyword_num);
     text_rank.TransformKeywords(res_vec);
     return result;
 }
+
+/*
+ * 近似模式，用于超长文档，保证时延可控
+ * 迭代残差估计的误差可以通过text_rank_approx_error获取
+ * */
+int *text_rank_approx_wrapper(char *corpus, int keyword_num, int time_budget_ms, int min_degree,
+                              int max_sentence_num) {
+    if (corpus == nullptr) {
+        result[0] = 0;
+        approx_error = 0;
+        return result;
+    }
+    string param_corpus = corpus;
+    TextRank text_rank = TextRank(param_corpus);
+    text_rank.SetApproxMode(time_budget_ms, min_degree, max_sentence_num);
+    vector<WordTerm> res_vec = text_rank.GetKeywords(keyword_num);
+    text_rank.TransformKeywords(res_vec);
+    approx_error = text_rank.GetEstimatedError();
+    return result;
+}
+
+/*
+ * 只反映迭代未收敛带来的误差，是每个单词分数误差的上界，采样、剪枝或超时改变了结果时返回-1
+ * */
+float text_rank_approx_error() {
+    return approx_error;
+}
 }